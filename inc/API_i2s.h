@@ -44,20 +44,28 @@ SPDX-License-Identifier: MIT
 #define BUFFER_SIZE_MIN 4
 #define SCALE_SIN_WAVE  16383
 #define SCALE_SAW_WAVE  32767
+#define SCALE_BL_WAVE   16383
+#define AMPLITUDE_MAX   100
+#define AMPLITUDE_MIN   0
 #define CHANNEL_0       0
 #define CHANNEL_1       1
 #define NULL            ((void *)0)
 
 /* === Public data type declarations ================================================ */
 
-typedef enum { SINUSOIDAL, SAWTOOTH } wave_t;
+typedef enum { SINUSOIDAL, SAWTOOTH, SAWTOOTH_BL, SQUARE_BL, TRIANGLE_BL } wave_t;
+
+typedef enum { INTERP_NONE, INTERP_LINEAR, INTERP_CUBIC } interp_t;
 
 typedef struct {
     uint8_t n_ch;                   // 0 o 1
-    wave_t wave_type;               // SINUSOIDAL o SAWTOOTH
+    wave_t wave_type;               // SINUSOIDAL, SAWTOOTH o *_BL (banda limitada)
     uint8_t amplitude;              // 0 to 100 [%]
     uint16_t freq;                  // 20 to 24000 [Hz]
     uint16_t size_buffer;           // 4 to 4800
+    interp_t interp;                // interpolacion de fillBufferI2S
+    uint32_t phase;                 // fase actual de fillBufferI2S (1 periodo = 2^32)
+    uint32_t phase_inc;             // incremento de fase por muestra (freq exacta)
     int16_t wdata[BUFFER_SIZE_MAX]; // vector que contiene la forma de onda
 } channel;
 
@@ -67,6 +75,8 @@ typedef struct {
 
 /**
  * @brief  Inicializa canales
+ *         (la primera vez calcula las tablas de ondas, antes de usar el I2S)
+ *         El calculo no usa buffers auxiliares: alcanza con el stack minimo (1 KB)
  *
  * @param  - handle de canal 0 y canal 1
  * @return - 0 = OK o -1 = ERROR
@@ -109,6 +119,28 @@ int setWaveChannel(channel * h_ch, wave_t wave_type);
  */
 int setBufferI2S(channel * h_ch0, channel * h_ch1, int32_t * pBufferI2S);
 
+/**
+ * @brief  Setea el orden de interpolacion de un canal para fillBufferI2S
+ *
+ * @param  channel * h_ch : handle de canal
+ *         interp_t interp : INTERP_NONE (muestra mas cercana), INTERP_LINEAR o INTERP_CUBIC
+ * @return - 0 = OK o -1 = ERROR
+ */
+int setInterpChannel(channel * h_ch, interp_t interp);
+
+/**
+ * @brief  Arma n_frames datos I2S de los 2 canales con la frecuencia exacta pedida,
+ *         leyendo las tablas con paso fraccionario. La fase de cada canal continua
+ *         entre llamadas, por lo que se puede usar para llenar bloques de un DMA
+ *
+ * @param  channel * h_ch0 : handle de canal 0
+ *         channel * h_ch1 : handle de canal 1
+ *         int32_t * pBufferI2S : buffer I2S de al menos n_frames datos
+ *         uint16_t n_frames : cantidad de datos a generar
+ * @return - 0 = OK o -1 = ERROR
+ */
+int fillBufferI2S(channel * h_ch0, channel * h_ch1, int32_t * pBufferI2S, uint16_t n_frames);
+
 /* === End of documentation ========================================================== */
 
 #endif /* API_INC_API_I2S_H_ */
@@ -0,0 +1,114 @@
+/****************************************************************************************
+Copyright (c) 2024, Flavio Miravete <flavio.miravete@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+SPDX-License-Identifier: MIT
+****************************************************************************************/
+
+/** @file
+ *  @brief TP Final PdM y PCSE (CESE 2023)
+ *         Titulo: Modulo API_i2s_cache (HEADER)
+ *
+ *         Cache LRU de buffers I2S ya armados para presets de uso frecuente.
+ *         La memoria de los buffers la provee el usuario (pool de int32_t).
+ *
+ */
+
+#ifndef API_INC_API_I2S_CACHE_H_
+#define API_INC_API_I2S_CACHE_H_
+
+/* === Headers files inclusions ====================================================== */
+
+#include "API_i2s.h"
+
+/* === Public Macros definitions ===================================================== */
+
+#define PRESET_CACHE_SLOTS_MAX 8
+
+/* === Public data type declarations ================================================ */
+
+typedef struct {
+    uint16_t freq;    // 20 to 24000 [Hz] (ambos canales)
+    wave_t wave_ch0;  // forma de onda canal 0
+    uint8_t amp_ch0;  // 0 to 100 [%] canal 0
+    wave_t wave_ch1;  // forma de onda canal 1
+    uint8_t amp_ch1;  // 0 to 100 [%] canal 1
+} preset_t;
+
+typedef struct {
+    preset_t key;         // configuracion completa de ambos canales
+    int32_t * pdata;      // buffer I2S armado (dentro del pool del usuario)
+    uint16_t size_buffer; // cantidad de datos validos en pdata
+    uint32_t last_use;    // marca de tiempo LRU
+    bool valid;           // slot ocupado
+} preset_slot;
+
+typedef struct {
+    preset_slot slot[PRESET_CACHE_SLOTS_MAX];
+    uint8_t n_slots;    // cantidad de slots que entran en el pool
+    uint16_t slot_size; // tamaño de cada slot (en datos de 32 bits)
+    uint32_t tick;      // contador de accesos para LRU
+    uint32_t hits;      // presets encontrados en cache
+    uint32_t misses;    // presets que hubo que generar
+    uint32_t evictions; // presets descartados por falta de lugar
+} preset_cache;
+
+/* === Public variable declarations ================================================= */
+
+/* === Public function declarations ================================================= */
+
+/**
+ * @brief  Inicializa la cache de presets sobre un pool de memoria del usuario
+ *
+ * @param  preset_cache * h_cache : handle de la cache
+ *         int32_t * pool : memoria para los buffers I2S
+ *         uint32_t pool_size : tamaño del pool (en datos de 32 bits)
+ *         uint16_t slot_size : tamaño de cada slot (BUFFER_SIZE_MIN a BUFFER_SIZE_MAX)
+ * @return - 0 = OK o -1 = ERROR
+ */
+int presetCacheInit(preset_cache * h_cache, int32_t * pool, uint32_t pool_size,
+                    uint16_t slot_size);
+
+/**
+ * @brief  Selecciona un preset. Si esta en cache devuelve el buffer ya armado sin
+ *         tocar los canales; si no, configura los canales, arma el buffer en un slot
+ *         (descartando el de uso menos reciente si hace falta) y lo devuelve
+ *
+ * @param  preset_cache * h_cache : handle de la cache
+ *         const preset_t * preset : configuracion pedida
+ *         channel * h_ch0 : handle de canal 0 (se usa solo si el preset no esta en cache)
+ *         channel * h_ch1 : handle de canal 1 (se usa solo si el preset no esta en cache)
+ *         int32_t ** ppBufferI2S : devuelve el puntero al buffer I2S del preset
+ *         uint16_t * pSize : devuelve la cantidad de datos del buffer
+ * @return - 0 = OK o -1 = ERROR (punteros invalidos o preset mas grande que un slot)
+ */
+int presetCacheSelect(preset_cache * h_cache, const preset_t * preset, channel * h_ch0,
+                      channel * h_ch1, int32_t ** ppBufferI2S, uint16_t * pSize);
+
+/**
+ * @brief  Invalida todos los presets de la cache y pone a cero los contadores
+ *
+ * @param  preset_cache * h_cache : handle de la cache
+ * @return - 0 = OK o -1 = ERROR
+ */
+int presetCacheFlush(preset_cache * h_cache);
+
+/* === End of documentation ========================================================== */
+
+#endif /* API_INC_API_I2S_CACHE_H_ */
@@ -38,6 +38,31 @@ SPDX-License-Identifier: MIT
  *              (16 bits mas significativos -> canal 0)
  *              (16 bits menos significativos -> canal 1)
  *
+ *         Ondas de banda limitada (SAWTOOTH_BL, SQUARE_BL, TRIANGLE_BL)
+ *         Se leen de tablas precalculadas, una por octava, que solo contienen los
+ *         armonicos que entran por debajo de FREQ_SAMPLING / 2 -> sin aliasing hasta FREQ_MAX
+ *         Tamaño de cada tabla -> WT_SIZE = 2^WT_SIZE_LOG2 (1024 por defecto)
+ *         Octava o -> size_buffer >= 4 * 2^o -> armonicos 1 a 2^(o+1) - 1
+ *         Ultima octava -> armonicos hasta WT_SIZE / 2 - 1 (511), usada para size_buffer >= 1024
+ *         (<= 93 Hz): un diente de sierra de 20 Hz llega a 10.2 kHz
+ *         Con size_buffer > WT_SIZE la tabla se interpola hacia arriba: los armonicos cerca de
+ *         WT_SIZE / 2 se atenuan y dejan imagenes por debajo de -60 dB
+ *         Las tablas se calculan una sola vez, en el primer channelsInit, para que
+ *         setChannel y fillBufferI2S (callback del DMA) no tengan demoras
+ *
+ *         Memoria (WT_SIZE_LOG2 = 10)
+ *         wavetable       -> WT_SHAPES * WT_OCTAVES * WT_SIZE * 2 = 54 KB de RAM estatica
+ *         wavetable_naive -> 2 * WT_SIZE * 2 = 4 KB de RAM estatica
+ *         wavetableInit   -> sin buffers auxiliares (acumulador float escalar)
+ *
+ *         Lectura con frecuencia exacta (fillBufferI2S)
+ *         setBufferI2S usa periodos enteros -> 7000 Hz suena en 96000/13 = 7384.6 Hz
+ *         fillBufferI2S recorre las tablas con una fase de 32 bits por canal
+ *         Incremento de fase -> freq * 2^32 / FREQ_SAMPLING (error < 0.0001 Hz)
+ *         Interpolacion por canal: INTERP_NONE (muestra mas cercana), INTERP_LINEAR o
+ *         INTERP_CUBIC (Catmull-Rom en punto fijo)
+ *         SINUSOIDAL y SAWTOOTH se leen de tablas propias, *_BL de la tabla de su octava
+ *
  **/
 
 /* === Headers files inclusions =============================================================== */
@@ -49,10 +74,18 @@ SPDX-License-Identifier: MIT
 /* === Macros definitions ====================================================================== */
 
 #define INITIAL_FREQ   1000
-#define AMPLITUDE_MAX  100
-#define AMPLITUDE_MIN  0
 #define QUANT_CHANNELS 2
 
+#ifndef WT_SIZE_LOG2
+#define WT_SIZE_LOG2 10
+#endif
+#define WT_SIZE      (1 << WT_SIZE_LOG2)
+#define WT_OCTAVES   (WT_SIZE_LOG2 - 1)
+#define WT_SHAPES    3
+#define WT_FRAC_BITS 15
+#define WT_MASK      (WT_SIZE - 1)
+#define PHASE_SHIFT  (32 - WT_SIZE_LOG2)
+
 /* === Private data type declarations ========================================================== */
 
 /* === Private variable declarations =========================================================== */
@@ -60,11 +93,20 @@ SPDX-License-Identifier: MIT
 static channel * ch_0;
 static channel * ch_1;
 static int32_t * buff_I2S;
+static int16_t wavetable[WT_SHAPES][WT_OCTAVES][WT_SIZE];
+static int16_t wavetable_naive[2][WT_SIZE]; // SINUSOIDAL y SAWTOOTH para fillBufferI2S
+static bool wavetable_ready = false;
 
 /* === Private function declarations =========================================================== */
 
 static int setSizeBuffer(channel * h_ch, uint16_t frequency);
 static int setChannel(channel * h_ch);
+static float harmonicGain(wave_t wave_type, uint16_t k);
+static void wavetableInit(void);
+static uint8_t wavetableOctave(uint16_t size_buffer);
+static void setChannelBL(channel * h_ch);
+static void writeSample(int32_t * pData, int32_t sample, int32_t scale, bool upper);
+static void fillChannel(channel * h_ch, int32_t * pBuffI2S, uint16_t n_frames, bool upper);
 
 /* === Public variable definitions ============================================================= */
 
@@ -93,6 +135,7 @@ static int setSizeBuffer(channel * h_ch, uint16_t frequency) {
     //     size_buffer = BUFFER_SIZE_MIN;
     h_ch->freq = frequency;
     h_ch->size_buffer = size_buffer;
+    h_ch->phase_inc = ((uint64_t)frequency << 32) / FREQ_SAMPLING;
     return 0;
     //} else
     //    return -1;
@@ -108,19 +151,201 @@ channel que contiene los atributos de cada canal
 */
 static int setChannel(channel * h_ch) {
     // if (h_ch != NULL) {
+    if (h_ch->wave_type >= SAWTOOTH_BL && h_ch->wave_type <= TRIANGLE_BL) {
+        setChannelBL(h_ch);
+        return 0;
+    }
     uint16_t size_buffer = h_ch->size_buffer;
     for (uint16_t i = 0; i < size_buffer; i++) {
         if (h_ch->wave_type == SINUSOIDAL)
-            h_ch->wdata[i] = (h_ch->amplitude / 100.0) * SCALE_SIN_WAVE * 1 *
-                             (i * 2 * M_PI / size_buffer); // 1 = sinf
+            h_ch->wdata[i] =
+                (h_ch->amplitude / 100.0) * SCALE_SIN_WAVE * sinf(i * 2 * M_PI / size_buffer);
         if (h_ch->wave_type == SAWTOOTH)
-            h_ch->wdata[i] = (h_ch->amplitude / 100.0) * i * (SCALE_SAW_WAVE / size_buffer);
+            h_ch->wdata[i] = (h_ch->amplitude / 100.0) * i * SCALE_SAW_WAVE / size_buffer;
     }
     //} else
     //    return -1;
     return 0;
 }
 
+/*
+**********************************************************************************************************
+Funcion : float harmonicGain(wave_t wave_type, uint16_t k)
+Funcion que devuelve la amplitud del armonico k (serie de Fourier en senos) de cada
+forma de onda de banda limitada:
+SAWTOOTH_BL -> -1/k (rampa ascendente que arranca en el minimo, como SAWTOOTH)
+SQUARE_BL   -> 1/k solo armonicos impares
+TRIANGLE_BL -> (-1)^((k-1)/2) / k^2 solo armonicos impares
+**********************************************************************************************************
+*/
+static float harmonicGain(wave_t wave_type, uint16_t k) {
+    if (wave_type == SAWTOOTH_BL)
+        return -1.0f / k;
+    if ((k & 1) == 0)
+        return 0;
+    if (wave_type == SQUARE_BL)
+        return 1.0f / k;
+    return ((k >> 1) & 1) ? -1.0f / ((float)k * k) : 1.0f / ((float)k * k);
+}
+
+/*
+**********************************************************************************************************
+Funcion : void wavetableInit(void)
+Funcion que calcula las tablas de banda limitada de todas las formas de onda.
+Todas las octavas de una forma de onda usan la misma ganancia, asi el armonico k tiene
+la misma amplitud en todas las tablas y el nivel no salta al cambiar de octava. La
+ganancia lleva a SCALE_BL_WAVE el mayor pico de todas las octavas (en la cuadrada las
+octavas bajas tienen mas overshoot que la mas rica).
+Los senos se leen de wavetable_naive[SINUSOIDAL] (k * n modulo WT_SIZE) para no llamar
+a sinf por termino. Cada muestra se acumula en un float escalar, sin buffers auxiliares.
+**********************************************************************************************************
+*/
+static void wavetableInit(void) {
+    const int16_t * sine = wavetable_naive[SINUSOIDAL];
+    for (uint16_t n = 0; n < WT_SIZE; n++) {
+        wavetable_naive[SINUSOIDAL][n] = lrintf(sinf(2 * M_PI * n / WT_SIZE) * SCALE_SIN_WAVE);
+        wavetable_naive[SAWTOOTH][n] = (int32_t)n * SCALE_SAW_WAVE / WT_SIZE;
+    }
+    for (uint8_t shape = 0; shape < WT_SHAPES; shape++) {
+        wave_t wave_type = SAWTOOTH_BL + shape;
+        float peak = 0;
+        for (uint32_t n = 0; n < WT_SIZE; n++) {
+            float acc = 0;
+            uint32_t k = 1;
+            for (uint8_t octave = 0; octave < WT_OCTAVES; octave++) {
+                for (; k < (2u << octave); k++)
+                    acc += harmonicGain(wave_type, k) * sine[(k * n) & WT_MASK];
+                if (fabsf(acc) > peak)
+                    peak = fabsf(acc);
+            }
+        }
+        float gain = SCALE_BL_WAVE / peak;
+        for (uint32_t n = 0; n < WT_SIZE; n++) {
+            float acc = 0;
+            uint32_t k = 1;
+            for (uint8_t octave = 0; octave < WT_OCTAVES; octave++) {
+                for (; k < (2u << octave); k++)
+                    acc += harmonicGain(wave_type, k) * sine[(k * n) & WT_MASK];
+                wavetable[shape][octave][n] = lrintf(acc * gain);
+            }
+        }
+    }
+    wavetable_ready = true;
+}
+
+/*
+**********************************************************************************************************
+Funcion : uint8_t wavetableOctave(uint16_t size_buffer)
+Funcion que elige la tabla con mas armonicos que no genera aliasing para un periodo
+de size_buffer muestras (todos los armonicos por debajo de size_buffer / 2).
+**********************************************************************************************************
+*/
+static uint8_t wavetableOctave(uint16_t size_buffer) {
+    uint8_t octave = 0;
+    while (octave < WT_OCTAVES - 1 && size_buffer >= (BUFFER_SIZE_MIN << (octave + 1)))
+        octave++;
+    return octave;
+}
+
+/*
+**********************************************************************************************************
+Funcion : void setChannelBL(channel * h_ch)
+Funcion que genera un periodo de una onda de banda limitada leyendo la tabla de la
+octava que corresponde al tamaño del buffer, con interpolacion lineal entre muestras.
+**********************************************************************************************************
+*/
+static void setChannelBL(channel * h_ch) {
+    uint16_t size_buffer = h_ch->size_buffer;
+    const int16_t * table =
+        wavetable[h_ch->wave_type - SAWTOOTH_BL][wavetableOctave(size_buffer)];
+    for (uint16_t i = 0; i < size_buffer; i++) {
+        uint32_t pos = (uint32_t)i * WT_SIZE;
+        uint16_t idx = pos / size_buffer;
+        int32_t frac = ((pos % size_buffer) << WT_FRAC_BITS) / size_buffer;
+        int32_t a = table[idx];
+        int32_t b = table[(idx + 1) & (WT_SIZE - 1)];
+        int32_t sample = a + (((b - a) * frac) >> WT_FRAC_BITS);
+        h_ch->wdata[i] = sample * h_ch->amplitude / 100;
+    }
+}
+
+/*
+**********************************************************************************************************
+Funcion : void writeSample(int32_t * pData, int32_t sample, int32_t scale, bool upper)
+Funcion que escala una muestra (scale en Q15, 32768 = 100 %) y la escribe en su mitad
+del dato I2S: con upper = true en los 16 bits altos (canal 0) dejando en cero los bajos,
+si no en los 16 bits bajos (canal 1) sin tocar los altos.
+**********************************************************************************************************
+*/
+static void writeSample(int32_t * pData, int32_t sample, int32_t scale, bool upper) {
+    uint16_t data = (uint16_t)((sample * scale) >> 15);
+    if (upper)
+        *pData = (int32_t)((uint32_t)data << 16);
+    else
+        *pData = (int32_t)((uint32_t)*pData | data);
+}
+
+/*
+**********************************************************************************************************
+Funcion : void fillChannel(channel * h_ch, int32_t * pBuffI2S, uint16_t n_frames, bool upper)
+Funcion que genera n_frames muestras de un canal avanzando su fase con paso fraccionario.
+Con upper = true escribe el canal 0, si no el canal 1 (ver writeSample).
+Hay un lazo por tipo de interpolacion para no decidir en cada muestra. La cubica
+(Catmull-Rom) se calcula en punto fijo con los coeficientes multiplicados por 2 y
+redondeo en cada paso de Horner.
+**********************************************************************************************************
+*/
+static void fillChannel(channel * h_ch, int32_t * pBuffI2S, uint16_t n_frames, bool upper) {
+    const int16_t * table;
+    if (h_ch->wave_type >= SAWTOOTH_BL && h_ch->wave_type <= TRIANGLE_BL)
+        table = wavetable[h_ch->wave_type - SAWTOOTH_BL]
+                         [wavetableOctave(FREQ_SAMPLING / h_ch->freq)];
+    else
+        table = wavetable_naive[h_ch->wave_type == SAWTOOTH ? SAWTOOTH : SINUSOIDAL];
+    int32_t scale = ((int32_t)h_ch->amplitude * (1 << 15) + AMPLITUDE_MAX / 2) / AMPLITUDE_MAX;
+    uint32_t phase = h_ch->phase;
+    uint32_t phase_inc = h_ch->phase_inc;
+    switch (h_ch->interp) {
+    case INTERP_LINEAR:
+        for (uint16_t i = 0; i < n_frames; i++, phase += phase_inc) {
+            uint16_t idx = phase >> PHASE_SHIFT;
+            int32_t frac = (phase << WT_SIZE_LOG2) >> (32 - WT_FRAC_BITS);
+            int32_t y0 = table[idx];
+            int32_t y1 = table[(idx + 1) & WT_MASK];
+            writeSample(&pBuffI2S[i], y0 + (((y1 - y0) * frac) >> WT_FRAC_BITS), scale, upper);
+        }
+        break;
+    case INTERP_CUBIC:
+        for (uint16_t i = 0; i < n_frames; i++, phase += phase_inc) {
+            uint16_t idx = phase >> PHASE_SHIFT;
+            int64_t frac = (phase << WT_SIZE_LOG2) >> (32 - WT_FRAC_BITS);
+            int32_t ym1 = table[(idx - 1) & WT_MASK];
+            int32_t y0 = table[idx];
+            int32_t y1 = table[(idx + 1) & WT_MASK];
+            int32_t y2 = table[(idx + 2) & WT_MASK];
+            int32_t c1 = y1 - ym1;
+            int32_t c2 = 2 * ym1 - 5 * y0 + 4 * y1 - y2;
+            int32_t c3 = (y2 - ym1) + 3 * (y0 - y1);
+            int32_t t = (c3 * frac + (1 << (WT_FRAC_BITS - 1))) >> WT_FRAC_BITS;
+            t = ((t + c2) * frac + (1 << (WT_FRAC_BITS - 1))) >> WT_FRAC_BITS;
+            t = ((t + c1) * frac + (1 << (WT_FRAC_BITS - 1))) >> WT_FRAC_BITS;
+            int32_t sample = y0 + ((t + 1) >> 1);
+            if (sample > INT16_MAX)
+                sample = INT16_MAX;
+            if (sample < INT16_MIN)
+                sample = INT16_MIN;
+            writeSample(&pBuffI2S[i], sample, scale, upper);
+        }
+        break;
+    default:
+        for (uint16_t i = 0; i < n_frames; i++, phase += phase_inc)
+            writeSample(&pBuffI2S[i], table[(phase + (1u << (PHASE_SHIFT - 1))) >> PHASE_SHIFT],
+                        scale, upper);
+        break;
+    }
+    h_ch->phase = phase;
+}
+
 /* === Public function implementation ========================================================== */
 
 /*
@@ -129,6 +354,7 @@ Funcion : void channelsInit(void)
 Funcion que inicializa los canales del generador de onda.
 Canal 0 -> Sinusoidal, 1000Hz, Amplitud 100%
 Canal 1 -> Sawtooth, 1000Hz, Amplitud 100%
+La primera vez calcula las tablas de ondas (debe llamarse antes de fillBufferI2S).
 **********************************************************************************************************
 */
 int channelsInit(channel * ch0, channel * ch1) {
@@ -144,6 +370,12 @@ int channelsInit(channel * ch0, channel * ch1) {
     ch_1->n_ch = CHANNEL_1;
     ch_1->wave_type = SAWTOOTH;
     ch_1->freq = INITIAL_FREQ;
+    ch_0->interp = INTERP_LINEAR;
+    ch_0->phase = 0;
+    ch_1->interp = INTERP_LINEAR;
+    ch_1->phase = 0;
+    if (!wavetable_ready)
+        wavetableInit();
     setSizeBuffer(ch_0, INITIAL_FREQ);
     setSizeBuffer(ch_1, INITIAL_FREQ);
     setChannel(ch_0);
@@ -229,6 +461,7 @@ int setWaveChannel(channel * h_ch, wave_t wave_type) {
 Funcion : void setBufferI2S(channel * h_ch0 , channel * h_ch1 , int32_t * pBuffI2S)
 Funcion que arma el buffer con los datos de los 2 canales para ser enviados por I2S.
 Recibe como parametro el handle de cada canal y el puntero al buffer I2S
+Canal 0 en los 16 bits altos y canal 1 en los 16 bits bajos (sin extension de signo)
 **********************************************************************************************************
 */
 int setBufferI2S(channel * h_ch0, channel * h_ch1, int32_t * pBuffI2S) {
@@ -236,17 +469,47 @@ int setBufferI2S(channel * h_ch0, channel * h_ch1, int32_t * pBuffI2S) {
         ch_0 = h_ch0;
         ch_1 = h_ch1;
         buff_I2S = pBuffI2S;
-        int32_t aux;
         uint16_t size_buffer = ch_0->size_buffer;
-        for (uint16_t i = 0; i < size_buffer; i++) {
-            buff_I2S[i] = ch_0->wdata[i];
-            aux = buff_I2S[i] << 16;
-            buff_I2S[i] = aux;
-            buff_I2S[i] = buff_I2S[i] + (int32_t)ch_1->wdata[i];
-        }
+        for (uint16_t i = 0; i < size_buffer; i++)
+            buff_I2S[i] = (int32_t)(((uint32_t)(uint16_t)ch_0->wdata[i] << 16) |
+                                    (uint16_t)ch_1->wdata[i]);
     } else
         return -1;
     return 0;
 }
 
+/*
+**********************************************************************************************************
+Funcion : int setInterpChannel(channel * h_ch, interp_t interp)
+Funcion que define el orden de interpolacion de un canal para fillBufferI2S.
+Recibe como parametros el handle de canal y el tipo de interpolacion.
+**********************************************************************************************************
+*/
+int setInterpChannel(channel * h_ch, interp_t interp) {
+    if (h_ch == NULL || interp > INTERP_CUBIC)
+        return -1;
+    h_ch->interp = interp;
+    return 0;
+}
+
+/*
+**********************************************************************************************************
+Funcion : int fillBufferI2S(channel * h_ch0, channel * h_ch1, int32_t * pBuffI2S,
+                            uint16_t n_frames)
+Funcion que arma n_frames datos I2S con la frecuencia exacta de cada canal.
+Recibe como parametro el handle de cada canal, el puntero al buffer I2S y la
+cantidad de datos a generar.
+**********************************************************************************************************
+*/
+int fillBufferI2S(channel * h_ch0, channel * h_ch1, int32_t * pBuffI2S, uint16_t n_frames) {
+    if (h_ch0 == NULL || h_ch1 == NULL || pBuffI2S == NULL)
+        return -1;
+    ch_0 = h_ch0;
+    ch_1 = h_ch1;
+    buff_I2S = pBuffI2S;
+    fillChannel(ch_0, buff_I2S, n_frames, true);
+    fillChannel(ch_1, buff_I2S, n_frames, false);
+    return 0;
+}
+
 /* === End of documentation ==================================================================== */
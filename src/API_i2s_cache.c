@@ -0,0 +1,213 @@
+/************************************************************************************************
+Copyright (c) 2024, Flavio Miravete <flavio.miravete@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** @file
+ ** @brief Cache LRU de buffers I2S para presets de uso frecuente
+ *         Cada preset (frecuencia, forma de onda y amplitud de ambos canales) se guarda
+ *         ya armado como buffer I2S de 32 bits. Cambiar a un preset que esta en cache es
+ *         solo devolver un puntero: no se recalculan setSizeBuffer, setChannel ni
+ *         setBufferI2S. Datos a considerar:
+ *
+ *         El pool de memoria lo provee el usuario y se divide en slots de igual tamaño
+ *         Cantidad de slots -> min(pool_size / slot_size, PRESET_CACHE_SLOTS_MAX)
+ *         Un preset entra en un slot si FREQ_SAMPLING / freq <= slot_size
+ *         Con slot_size = BUFFER_SIZE_MAX entra cualquier preset
+ *
+ *         Contadores para ajustar el tamaño de la cache: hits, misses y evictions
+ *
+ **/
+
+/* === Headers files inclusions =============================================================== */
+
+#include "API_i2s_cache.h"
+#include <stdbool.h>
+
+/* === Macros definitions ====================================================================== */
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static int presetNormalize(const preset_t * preset, preset_t * key);
+static bool presetEqual(const preset_t * a, const preset_t * b);
+static preset_slot * presetVictim(preset_cache * h_cache);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+/*
+**********************************************************************************************************
+Funcion : int presetNormalize(const preset_t * preset, preset_t * key)
+Funcion que limita los valores del preset igual que lo hacen setFreqChannels y
+setAmpChannel, para que presets equivalentes tengan la misma clave en la cache.
+Devuelve error si alguna forma de onda no es valida (no se puede generar).
+**********************************************************************************************************
+*/
+static int presetNormalize(const preset_t * preset, preset_t * key) {
+    if (preset->wave_ch0 > TRIANGLE_BL || preset->wave_ch1 > TRIANGLE_BL)
+        return -1;
+    *key = *preset;
+    if (key->freq > FREQ_MAX)
+        key->freq = FREQ_MAX;
+    if (key->freq < FREQ_MIN)
+        key->freq = FREQ_MIN;
+    if (key->amp_ch0 > AMPLITUDE_MAX)
+        key->amp_ch0 = AMPLITUDE_MAX;
+    if (key->amp_ch1 > AMPLITUDE_MAX)
+        key->amp_ch1 = AMPLITUDE_MAX;
+    return 0;
+}
+
+/*
+**********************************************************************************************************
+Funcion : bool presetEqual(const preset_t * a, const preset_t * b)
+Funcion que compara dos claves campo por campo (no se usa memcmp por el padding).
+**********************************************************************************************************
+*/
+static bool presetEqual(const preset_t * a, const preset_t * b) {
+    return a->freq == b->freq && a->wave_ch0 == b->wave_ch0 && a->amp_ch0 == b->amp_ch0 &&
+           a->wave_ch1 == b->wave_ch1 && a->amp_ch1 == b->amp_ch1;
+}
+
+/*
+**********************************************************************************************************
+Funcion : preset_slot * presetVictim(preset_cache * h_cache)
+Funcion que elige el slot donde guardar un preset nuevo: el primer slot libre o,
+si estan todos ocupados, el de uso menos reciente (cuenta una eviction).
+**********************************************************************************************************
+*/
+static preset_slot * presetVictim(preset_cache * h_cache) {
+    preset_slot * victim = &h_cache->slot[0];
+    for (uint8_t i = 0; i < h_cache->n_slots; i++) {
+        if (!h_cache->slot[i].valid)
+            return &h_cache->slot[i];
+        if (h_cache->slot[i].last_use < victim->last_use)
+            victim = &h_cache->slot[i];
+    }
+    h_cache->evictions++;
+    return victim;
+}
+
+/* === Public function implementation ========================================================== */
+
+/*
+**********************************************************************************************************
+Funcion : int presetCacheInit(preset_cache * h_cache, int32_t * pool, uint32_t pool_size,
+                              uint16_t slot_size)
+Funcion que divide el pool del usuario en slots y deja la cache vacia.
+Devuelve error si en el pool no entra ningun slot.
+**********************************************************************************************************
+*/
+int presetCacheInit(preset_cache * h_cache, int32_t * pool, uint32_t pool_size,
+                    uint16_t slot_size) {
+    if (h_cache == NULL || pool == NULL)
+        return -1;
+    if (slot_size < BUFFER_SIZE_MIN || slot_size > BUFFER_SIZE_MAX || pool_size < slot_size)
+        return -1;
+    uint32_t n_slots = pool_size / slot_size;
+    if (n_slots > PRESET_CACHE_SLOTS_MAX)
+        n_slots = PRESET_CACHE_SLOTS_MAX;
+    h_cache->n_slots = n_slots;
+    h_cache->slot_size = slot_size;
+    for (uint8_t i = 0; i < PRESET_CACHE_SLOTS_MAX; i++)
+        h_cache->slot[i].pdata = (i < n_slots) ? &pool[(uint32_t)i * slot_size] : NULL;
+    return presetCacheFlush(h_cache);
+}
+
+/*
+**********************************************************************************************************
+Funcion : int presetCacheSelect(preset_cache * h_cache, const preset_t * preset,
+                                channel * h_ch0, channel * h_ch1,
+                                int32_t ** ppBufferI2S, uint16_t * pSize)
+Funcion que devuelve el buffer I2S de un preset. Si el preset no esta en cache se
+generan las ondas en los canales recibidos (una sola vez por canal) y se arma el
+buffer directamente en el slot elegido.
+**********************************************************************************************************
+*/
+int presetCacheSelect(preset_cache * h_cache, const preset_t * preset, channel * h_ch0,
+                      channel * h_ch1, int32_t ** ppBufferI2S, uint16_t * pSize) {
+    if (h_cache == NULL || preset == NULL || h_ch0 == NULL || h_ch1 == NULL ||
+        ppBufferI2S == NULL || pSize == NULL)
+        return -1;
+    preset_t key;
+    if (presetNormalize(preset, &key) != 0)
+        return -1;
+    h_cache->tick++;
+    for (uint8_t i = 0; i < h_cache->n_slots; i++) {
+        preset_slot * slot = &h_cache->slot[i];
+        if (slot->valid && presetEqual(&slot->key, &key)) {
+            slot->last_use = h_cache->tick;
+            h_cache->hits++;
+            *ppBufferI2S = slot->pdata;
+            *pSize = slot->size_buffer;
+            return 0;
+        }
+    }
+    if (FREQ_SAMPLING / key.freq > h_cache->slot_size)
+        return -1;
+    h_ch0->wave_type = key.wave_ch0;
+    h_ch0->amplitude = key.amp_ch0;
+    h_ch1->wave_type = key.wave_ch1;
+    h_ch1->amplitude = key.amp_ch1;
+    if (setFreqChannels(h_ch0, h_ch1, key.freq) != 0)
+        return -1;
+    preset_slot * slot = presetVictim(h_cache);
+    slot->valid = false;
+    if (setBufferI2S(h_ch0, h_ch1, slot->pdata) != 0)
+        return -1;
+    slot->key = key;
+    slot->size_buffer = h_ch0->size_buffer;
+    slot->last_use = h_cache->tick;
+    slot->valid = true;
+    h_cache->misses++;
+    *ppBufferI2S = slot->pdata;
+    *pSize = slot->size_buffer;
+    return 0;
+}
+
+/*
+**********************************************************************************************************
+Funcion : int presetCacheFlush(preset_cache * h_cache)
+Funcion que invalida todos los slots y reinicia los contadores de la cache.
+Se debe llamar si se modifica el contenido del pool por fuera de la cache.
+**********************************************************************************************************
+*/
+int presetCacheFlush(preset_cache * h_cache) {
+    if (h_cache == NULL)
+        return -1;
+    for (uint8_t i = 0; i < PRESET_CACHE_SLOTS_MAX; i++) {
+        h_cache->slot[i].valid = false;
+        h_cache->slot[i].size_buffer = 0;
+        h_cache->slot[i].last_use = 0;
+    }
+    h_cache->tick = 0;
+    h_cache->hits = 0;
+    h_cache->misses = 0;
+    h_cache->evictions = 0;
+    return 0;
+}
+
+/* === End of documentation ==================================================================== */
@@ -29,12 +29,16 @@ SPDX-License-Identifier: MIT
  *         - int setAmpChannel(uint8_t n_channel, uint8_t amplitude)
  *         - int setWaveChannel(uint8_t n_channel, wave_t wave_type)
  *         - int setBufferI2S(channel * h_ch0, channel * h_ch1, int32_t * pBufferI2S);
+ *         - ondas de banda limitada (SAWTOOTH_BL, SQUARE_BL, TRIANGLE_BL)
+ *         - int setInterpChannel(channel * h_ch, interp_t interp)
+ *         - int fillBufferI2S(channel * h_ch0, channel * h_ch1, int32_t * pBufferI2S, ...)
  */
 
 /* === Headers files inclusions =============================================================== */
 
 #include "unity.h"
 #include "API_i2s.h"
+#include <math.h>
 
 /* === Macros definitions ====================================================================== */
 
@@ -45,6 +49,7 @@ SPDX-License-Identifier: MIT
 #define TEST_BUFFER_SIZE_MIN 4
 #define TEST_SCALE_SIN_WAVE  16383
 #define TEST_SCALE_SAW_WAVE  32767
+#define TEST_SCALE_BL_WAVE   16383
 #define TEST_CHANNEL_0       0
 #define TEST_CHANNEL_1       1
 #define RETURN_ERROR         -1
@@ -59,15 +64,37 @@ SPDX-License-Identifier: MIT
 
 static channel T_channel_0, T_channel_1;
 static int32_t T_bufferI2S[TEST_BUFFER_SIZE_MAX];
+static int32_t T_bufferI2S_fill[TEST_BUFFER_SIZE_MAX];
 
 /* === Private function declarations =========================================================== */
 
+static double dftMagnitude(const int16_t * data, uint16_t size, uint16_t k);
+
 /* === Public variable definitions ============================================================= */
 
 /* === Private variable definitions ============================================================ */
 
 /* === Private function implementation ========================================================= */
 
+/**
+ * @brief  Amplitud del armonico k de un periodo de size muestras (DFT de un solo bin)
+ *
+ * @param  data : periodo de la señal
+ *         size : cantidad de muestras del periodo
+ *         k : numero de armonico
+ * @return - amplitud del armonico k
+ */
+static double dftMagnitude(const int16_t * data, uint16_t size, uint16_t k) {
+    double re = 0;
+    double im = 0;
+    for (uint16_t n = 0; n < size; n++) {
+        double angle = 2 * M_PI * ((uint32_t)k * n % size) / size;
+        re += data[n] * cos(angle);
+        im -= data[n] * sin(angle);
+    }
+    return 2 * sqrt(re * re + im * im) / size;
+}
+
 /* === Public function implementation ========================================================== */
 
 /**
@@ -370,3 +397,271 @@ void test_chequeo_armado_buffer_I2S(void) {
     }
     TEST_ASSERT_TRUE(flag);
 }
+
+/**
+ * @brief Test 7.1
+ *        Verificar que el diente de sierra de banda limitada en FREQ_MAX es solo la
+ *        fundamental (sin armonicos que generen aliasing)
+ *
+ * @param  -
+ * @return -
+ */
+void test_diente_de_sierra_banda_limitada_en_frecuencia_maxima(void) {
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, channelsInit(&T_channel_0, &T_channel_1));
+    setWaveChannel(&T_channel_1, SAWTOOTH_BL);
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, setFreqChannels(&T_channel_0, &T_channel_1, TEST_FREQ_MAX));
+    TEST_ASSERT_EQUAL_UINT16(TEST_BUFFER_SIZE_MIN, T_channel_1.size_buffer);
+    TEST_ASSERT_INT_WITHIN(1, 0, T_channel_1.wdata[0]);
+    TEST_ASSERT_LESS_THAN(-TEST_SCALE_BL_WAVE / 4, T_channel_1.wdata[1]);
+    TEST_ASSERT_INT_WITHIN(1, 0, T_channel_1.wdata[2]);
+    TEST_ASSERT_INT_WITHIN(1, -T_channel_1.wdata[1], T_channel_1.wdata[3]);
+}
+
+/**
+ * @brief Test 7.2
+ *        Verificar que las ondas de banda limitada respetan la escala y la amplitud
+ *
+ * @param  -
+ * @return -
+ */
+void test_ondas_banda_limitada_respetan_amplitud(void) {
+    const wave_t waves[] = {SAWTOOTH_BL, SQUARE_BL, TRIANGLE_BL};
+    const uint16_t freqs[] = {TEST_FREQ_MIN, 440, 7000, TEST_FREQ_MAX};
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, channelsInit(&T_channel_0, &T_channel_1));
+    setAmpChannel(&T_channel_1, 50);
+    for (uint8_t w = 0; w < 3; w++) {
+        setWaveChannel(&T_channel_0, waves[w]);
+        setWaveChannel(&T_channel_1, waves[w]);
+        for (uint8_t f = 0; f < 4; f++) {
+            setFreqChannels(&T_channel_0, &T_channel_1, freqs[f]);
+            int16_t peak_0 = 0;
+            int16_t peak_1 = 0;
+            for (uint16_t i = 0; i < T_channel_0.size_buffer; i++) {
+                TEST_ASSERT_INT_WITHIN(TEST_SCALE_BL_WAVE, 0, T_channel_0.wdata[i]);
+                if (T_channel_0.wdata[i] > peak_0)
+                    peak_0 = T_channel_0.wdata[i];
+                if (T_channel_1.wdata[i] > peak_1)
+                    peak_1 = T_channel_1.wdata[i];
+            }
+            TEST_ASSERT_INT_WITHIN(1, peak_0 / 2, peak_1);
+        }
+    }
+}
+
+/**
+ * @brief Test 7.3
+ *        Verificar la forma de la onda cuadrada de banda limitada
+ *
+ * @param  -
+ * @return -
+ */
+void test_onda_cuadrada_banda_limitada(void) {
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, channelsInit(&T_channel_0, &T_channel_1));
+    setWaveChannel(&T_channel_0, SQUARE_BL);
+    uint16_t size_buffer = T_channel_0.size_buffer;
+    TEST_ASSERT_GREATER_THAN(TEST_SCALE_BL_WAVE / 2, T_channel_0.wdata[size_buffer / 4]);
+    TEST_ASSERT_LESS_THAN(-TEST_SCALE_BL_WAVE / 2, T_channel_0.wdata[3 * size_buffer / 4]);
+}
+
+/**
+ * @brief Test 7.4
+ *        Verificar que el diente de sierra de banda limitada no tiene energia por encima
+ *        del ultimo armonico de su octava (hasta size_buffer / 2) y que ese armonico esta
+ *        presente, en los limites de eleccion de octava
+ *
+ * @param  -
+ * @return -
+ */
+void test_diente_de_sierra_banda_limitada_sin_aliasing(void) {
+    // size_buffer 13, 16, 96 y 4800 -> ultimo armonico 3, 7, 31 y 511
+    const uint16_t sizes[] = {13, 16, 96, TEST_BUFFER_SIZE_MAX};
+    const uint16_t top_harmonic[] = {3, 7, 31, 511};
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, channelsInit(&T_channel_0, &T_channel_1));
+    setWaveChannel(&T_channel_0, SAWTOOTH_BL);
+    for (uint8_t s = 0; s < 4; s++) {
+        setFreqChannels(&T_channel_0, &T_channel_1, TEST_FREQ_SAMPLING / sizes[s]);
+        TEST_ASSERT_EQUAL_UINT16(sizes[s], T_channel_0.size_buffer);
+        double fundamental = dftMagnitude(T_channel_0.wdata, sizes[s], 1);
+        uint16_t k_top = top_harmonic[s];
+        TEST_ASSERT_TRUE(dftMagnitude(T_channel_0.wdata, sizes[s], k_top) >
+                         fundamental / k_top / 4);
+        // Hasta WT_SIZE muestras solo queda redondeo; por encima, imagenes < -60 dB
+        double limit = (sizes[s] <= 1024) ? 2.0 : fundamental / 1000;
+        for (uint16_t k = k_top + 1; k <= sizes[s] / 2; k++)
+            TEST_ASSERT_TRUE(dftMagnitude(T_channel_0.wdata, sizes[s], k) < limit);
+    }
+}
+
+/**
+ * @brief Test 7.5
+ *        Verificar que el nivel de la fundamental no cambia al pasar de una octava a otra
+ *        (size_buffer 7 -> octava 0, size_buffer 8 -> octava 1) en todas las ondas *_BL
+ *
+ * @param  -
+ * @return -
+ */
+void test_ondas_banda_limitada_nivel_continuo_entre_octavas(void) {
+    const wave_t waves[] = {SAWTOOTH_BL, SQUARE_BL, TRIANGLE_BL};
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, channelsInit(&T_channel_0, &T_channel_1));
+    for (uint8_t w = 0; w < 3; w++) {
+        setWaveChannel(&T_channel_0, waves[w]);
+        setFreqChannels(&T_channel_0, &T_channel_1, TEST_FREQ_SAMPLING / 7);
+        TEST_ASSERT_EQUAL_UINT16(7, T_channel_0.size_buffer);
+        double level_7 = dftMagnitude(T_channel_0.wdata, 7, 1);
+        setFreqChannels(&T_channel_0, &T_channel_1, TEST_FREQ_SAMPLING / 8);
+        TEST_ASSERT_EQUAL_UINT16(8, T_channel_0.size_buffer);
+        double level_8 = dftMagnitude(T_channel_0.wdata, 8, 1);
+        // Menos de 0.1 dB de diferencia
+        TEST_ASSERT_TRUE(fabs(level_7 - level_8) < 0.012 * level_8);
+    }
+}
+
+/**
+ * @brief Test 8.1
+ *        Verificar punteros y valores validos al cambiar la interpolacion de un canal
+ *
+ * @param  -
+ * @return -
+ */
+void test_cambio_de_interpolacion_canal(void) {
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, channelsInit(&T_channel_0, &T_channel_1));
+    TEST_ASSERT_EQUAL(INTERP_LINEAR, T_channel_0.interp);
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR, setInterpChannel((void *)0, INTERP_CUBIC));
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR, setInterpChannel(&T_channel_0, INTERP_CUBIC + 1));
+    TEST_ASSERT_EQUAL(INTERP_LINEAR, T_channel_0.interp);
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, setInterpChannel(&T_channel_0, INTERP_CUBIC));
+    TEST_ASSERT_EQUAL(INTERP_CUBIC, T_channel_0.interp);
+}
+
+/**
+ * @brief Test 8.2
+ *        Verificar punteros validos en la llamada al llenado del buffer I2S
+ *
+ * @param  -
+ * @return -
+ */
+void test_chequeo_punteros_validos_llenado_buffer_I2S(void) {
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, channelsInit(&T_channel_0, &T_channel_1));
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR, fillBufferI2S((void *)0, &T_channel_1, T_bufferI2S, 8));
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR, fillBufferI2S(&T_channel_0, (void *)0, T_bufferI2S, 8));
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR, fillBufferI2S(&T_channel_0, &T_channel_1, (void *)0, 8));
+}
+
+/**
+ * @brief Test 8.3
+ *        Verificar que la fase continua entre llamadas al llenado del buffer I2S
+ *
+ * @param  -
+ * @return -
+ */
+void test_llenado_buffer_I2S_continuo_entre_llamadas(void) {
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, channelsInit(&T_channel_0, &T_channel_1));
+    setInterpChannel(&T_channel_1, INTERP_CUBIC);
+    setFreqChannels(&T_channel_0, &T_channel_1, 7000);
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, fillBufferI2S(&T_channel_0, &T_channel_1, T_bufferI2S, 200));
+
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, channelsInit(&T_channel_0, &T_channel_1));
+    setInterpChannel(&T_channel_1, INTERP_CUBIC);
+    setFreqChannels(&T_channel_0, &T_channel_1, 7000);
+    fillBufferI2S(&T_channel_0, &T_channel_1, T_bufferI2S_fill, 77);
+    fillBufferI2S(&T_channel_0, &T_channel_1, &T_bufferI2S_fill[77], 123);
+    TEST_ASSERT_EQUAL_INT32_ARRAY(T_bufferI2S, T_bufferI2S_fill, 200);
+}
+
+/**
+ * @brief Test 8.4
+ *        Verificar que el llenado del buffer I2S genera la frecuencia exacta pedida
+ *        (con setBufferI2S 7000 Hz suena en 96000 / 13 = 7384 Hz)
+ *
+ * @param  -
+ * @return -
+ */
+void test_llenado_buffer_I2S_frecuencia_exacta(void) {
+    const interp_t interps[] = {INTERP_NONE, INTERP_LINEAR, INTERP_CUBIC};
+    uint16_t test_frequency = 7000;
+    for (uint8_t n = 0; n < 3; n++) {
+        TEST_ASSERT_EQUAL_INT(RETURN_OK, channelsInit(&T_channel_0, &T_channel_1));
+        setWaveChannel(&T_channel_1, SINUSOIDAL);
+        setInterpChannel(&T_channel_1, interps[n]);
+        setFreqChannels(&T_channel_0, &T_channel_1, test_frequency);
+        uint32_t crossings = 0;
+        int16_t last = -1;
+        // Un segundo de señal en bloques de TEST_BUFFER_SIZE_MAX datos
+        for (uint8_t block = 0; block < TEST_FREQ_SAMPLING / TEST_BUFFER_SIZE_MAX; block++) {
+            fillBufferI2S(&T_channel_0, &T_channel_1, T_bufferI2S, TEST_BUFFER_SIZE_MAX);
+            for (uint16_t i = 0; i < TEST_BUFFER_SIZE_MAX; i++) {
+                int16_t data_ch1 = (int16_t)(T_bufferI2S[i] & 0xFFFF);
+                if (last < 0 && data_ch1 >= 0)
+                    crossings++;
+                last = data_ch1;
+            }
+        }
+        TEST_ASSERT_UINT32_WITHIN(1, test_frequency, crossings);
+    }
+}
+
+/**
+ * @brief Test 8.5
+ *        Verificar que con un periodo entero (1000 Hz -> 96 muestras) el llenado del buffer
+ *        I2S con interpolacion lineal coincide con setBufferI2S en todas las formas de onda
+ *
+ * @param  -
+ * @return -
+ */
+void test_llenado_buffer_I2S_coincide_con_armado_buffer_I2S(void) {
+    const wave_t waves[] = {SINUSOIDAL, SAWTOOTH, SAWTOOTH_BL, SQUARE_BL, TRIANGLE_BL};
+    for (uint8_t w = 0; w < 5; w++) {
+        TEST_ASSERT_EQUAL_INT(RETURN_OK, channelsInit(&T_channel_0, &T_channel_1));
+        setWaveChannel(&T_channel_0, waves[w]);
+        setWaveChannel(&T_channel_1, waves[w]);
+        setAmpChannel(&T_channel_1, 60);
+        setFreqChannels(&T_channel_0, &T_channel_1, TEST_INITIAL_FREQ);
+        uint16_t size_buffer = T_channel_0.size_buffer;
+        TEST_ASSERT_EQUAL_INT(RETURN_OK, setBufferI2S(&T_channel_0, &T_channel_1, T_bufferI2S));
+        TEST_ASSERT_EQUAL_INT(RETURN_OK, fillBufferI2S(&T_channel_0, &T_channel_1,
+                                                       T_bufferI2S_fill, size_buffer));
+        for (uint16_t i = 0; i < size_buffer; i++) {
+            int16_t period_ch1 = (int16_t)(T_bufferI2S[i] & 0xFFFF);
+            int16_t fill_ch1 = (int16_t)(T_bufferI2S_fill[i] & 0xFFFF);
+            TEST_ASSERT_INT_WITHIN(2, period_ch1, fill_ch1);
+            TEST_ASSERT_INT_WITHIN(2, (int16_t)(T_bufferI2S[i] >> 16),
+                                   (int16_t)(T_bufferI2S_fill[i] >> 16));
+        }
+    }
+}
+
+/**
+ * @brief Test 8.6
+ *        Verificar que una muestra negativa del canal 1 no modifica los bits del canal 0
+ *        (armado y llenado del buffer I2S)
+ *
+ * @param  -
+ * @return -
+ */
+void test_canal_1_negativo_no_modifica_canal_0(void) {
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, channelsInit(&T_channel_0, &T_channel_1));
+    setWaveChannel(&T_channel_0, SAWTOOTH);
+    setWaveChannel(&T_channel_1, SINUSOIDAL);
+    setFreqChannels(&T_channel_0, &T_channel_1, TEST_INITIAL_FREQ);
+    uint16_t size_buffer = T_channel_0.size_buffer;
+    TEST_ASSERT_LESS_THAN(0, T_channel_1.wdata[size_buffer * 3 / 4]);
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, setBufferI2S(&T_channel_0, &T_channel_1, T_bufferI2S));
+    for (uint16_t i = 0; i < size_buffer; i++) {
+        TEST_ASSERT_EQUAL_HEX16((uint16_t)T_channel_0.wdata[i],
+                                (uint32_t)T_bufferI2S[i] >> 16);
+        TEST_ASSERT_EQUAL_HEX16((uint16_t)T_channel_1.wdata[i], T_bufferI2S[i] & 0xFFFF);
+    }
+    // Mismo canal 0 con el canal 1 en cero y con el canal 1 negativo en medio periodo
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, fillBufferI2S(&T_channel_0, &T_channel_1,
+                                                   T_bufferI2S_fill, size_buffer));
+    setAmpChannel(&T_channel_1, 0);
+    T_channel_0.phase = 0;
+    T_channel_1.phase = 0;
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, fillBufferI2S(&T_channel_0, &T_channel_1, T_bufferI2S,
+                                                   size_buffer));
+    for (uint16_t i = 0; i < size_buffer; i++) {
+        TEST_ASSERT_EQUAL_HEX16((uint32_t)T_bufferI2S[i] >> 16,
+                                (uint32_t)T_bufferI2S_fill[i] >> 16);
+        TEST_ASSERT_EQUAL_HEX16(0, T_bufferI2S[i] & 0xFFFF);
+    }
+}
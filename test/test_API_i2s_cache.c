@@ -0,0 +1,228 @@
+/************************************************************************************************
+Copyright (c) 2024, Flavio Miravete <flavio.miravete@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** @file
+ *  @brief Modulo de Testeos para la cache de presets del driver API_i2s (ceedling)
+ *         Funciones en prueba:
+ *         - int presetCacheInit(preset_cache * h_cache, int32_t * pool, ...)
+ *         - int presetCacheSelect(preset_cache * h_cache, const preset_t * preset, ...)
+ *         - int presetCacheFlush(preset_cache * h_cache)
+ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "unity.h"
+#include "API_i2s.h"
+#include "API_i2s_cache.h"
+
+/* === Macros definitions ====================================================================== */
+
+#define TEST_FREQ_SAMPLING   96000
+#define TEST_BUFFER_SIZE_MAX 4800
+#define TEST_SLOT_SIZE       960
+#define TEST_POOL_SIZE       (3 * TEST_SLOT_SIZE)
+#define RETURN_ERROR         -1
+#define RETURN_OK            0
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+static channel T_channel_0, T_channel_1;
+static int32_t T_bufferI2S[TEST_BUFFER_SIZE_MAX];
+static int32_t T_pool[TEST_POOL_SIZE];
+static preset_cache T_cache;
+
+/* === Private function declarations =========================================================== */
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static const preset_t T_preset_a = {1000, SINUSOIDAL, 100, SAWTOOTH, 100};
+static const preset_t T_preset_b = {2000, SAWTOOTH, 50, SINUSOIDAL, 25};
+static const preset_t T_preset_c = {3000, SINUSOIDAL, 75, SINUSOIDAL, 75};
+static const preset_t T_preset_d = {4000, SAWTOOTH, 10, SAWTOOTH, 90};
+
+/* === Private function implementation ========================================================= */
+
+/* === Public function implementation ========================================================== */
+
+void setUp(void) {
+    channelsInit(&T_channel_0, &T_channel_1);
+    presetCacheInit(&T_cache, T_pool, TEST_POOL_SIZE, TEST_SLOT_SIZE);
+}
+
+/**
+ * @brief Test 6.1
+ *        Verificar punteros y tamaños validos en la inicializacion de la cache
+ *
+ * @param  -
+ * @return -
+ */
+void test_inicializacion_cache_de_presets(void) {
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR,
+                          presetCacheInit((void *)0, T_pool, TEST_POOL_SIZE, TEST_SLOT_SIZE));
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR,
+                          presetCacheInit(&T_cache, (void *)0, TEST_POOL_SIZE, TEST_SLOT_SIZE));
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR,
+                          presetCacheInit(&T_cache, T_pool, TEST_SLOT_SIZE - 1, TEST_SLOT_SIZE));
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR, presetCacheInit(&T_cache, T_pool, TEST_POOL_SIZE, 0));
+    TEST_ASSERT_EQUAL_INT(RETURN_OK,
+                          presetCacheInit(&T_cache, T_pool, TEST_POOL_SIZE, TEST_SLOT_SIZE));
+    TEST_ASSERT_EQUAL_UINT8(3, T_cache.n_slots);
+    TEST_ASSERT_EQUAL_UINT32(0, T_cache.hits);
+    TEST_ASSERT_EQUAL_UINT32(0, T_cache.misses);
+    TEST_ASSERT_EQUAL_UINT32(0, T_cache.evictions);
+}
+
+/**
+ * @brief Test 6.2
+ *        Verificar que un preset nuevo arma el mismo buffer que setBufferI2S
+ *
+ * @param  -
+ * @return -
+ */
+void test_preset_nuevo_arma_buffer_I2S(void) {
+    int32_t * p_buffer = NULL;
+    uint16_t size = 0;
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, presetCacheSelect(&T_cache, &T_preset_b, &T_channel_0,
+                                                       &T_channel_1, &p_buffer, &size));
+    TEST_ASSERT_EQUAL_UINT16(TEST_FREQ_SAMPLING / T_preset_b.freq, size);
+    TEST_ASSERT_EQUAL_UINT32(1, T_cache.misses);
+
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, setBufferI2S(&T_channel_0, &T_channel_1, T_bufferI2S));
+    TEST_ASSERT_EQUAL_INT32_ARRAY(T_bufferI2S, p_buffer, size);
+}
+
+/**
+ * @brief Test 6.3
+ *        Verificar que un preset en cache se devuelve sin regenerar los canales
+ *
+ * @param  -
+ * @return -
+ */
+void test_preset_en_cache_no_modifica_canales(void) {
+    int32_t * p_first = NULL;
+    int32_t * p_second = NULL;
+    uint16_t size = 0;
+    presetCacheSelect(&T_cache, &T_preset_a, &T_channel_0, &T_channel_1, &p_first, &size);
+    presetCacheSelect(&T_cache, &T_preset_b, &T_channel_0, &T_channel_1, &p_second, &size);
+    TEST_ASSERT_EQUAL_UINT16(T_preset_b.freq, T_channel_0.freq);
+
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, presetCacheSelect(&T_cache, &T_preset_a, &T_channel_0,
+                                                       &T_channel_1, &p_second, &size));
+    TEST_ASSERT_EQUAL_PTR(p_first, p_second);
+    TEST_ASSERT_EQUAL_UINT16(TEST_FREQ_SAMPLING / T_preset_a.freq, size);
+    TEST_ASSERT_EQUAL_UINT16(T_preset_b.freq, T_channel_0.freq);
+    TEST_ASSERT_EQUAL_UINT32(1, T_cache.hits);
+    TEST_ASSERT_EQUAL_UINT32(2, T_cache.misses);
+}
+
+/**
+ * @brief Test 6.4
+ *        Verificar que con la cache llena se descarta el preset de uso menos reciente
+ *
+ * @param  -
+ * @return -
+ */
+void test_cache_llena_descarta_preset_menos_usado(void) {
+    int32_t * p_buffer = NULL;
+    uint16_t size = 0;
+    presetCacheSelect(&T_cache, &T_preset_a, &T_channel_0, &T_channel_1, &p_buffer, &size);
+    presetCacheSelect(&T_cache, &T_preset_b, &T_channel_0, &T_channel_1, &p_buffer, &size);
+    presetCacheSelect(&T_cache, &T_preset_c, &T_channel_0, &T_channel_1, &p_buffer, &size);
+    // Uso A para que B quede como el menos reciente
+    presetCacheSelect(&T_cache, &T_preset_a, &T_channel_0, &T_channel_1, &p_buffer, &size);
+    presetCacheSelect(&T_cache, &T_preset_d, &T_channel_0, &T_channel_1, &p_buffer, &size);
+    TEST_ASSERT_EQUAL_UINT32(1, T_cache.evictions);
+
+    presetCacheSelect(&T_cache, &T_preset_a, &T_channel_0, &T_channel_1, &p_buffer, &size);
+    presetCacheSelect(&T_cache, &T_preset_c, &T_channel_0, &T_channel_1, &p_buffer, &size);
+    TEST_ASSERT_EQUAL_UINT32(3, T_cache.hits);
+    presetCacheSelect(&T_cache, &T_preset_b, &T_channel_0, &T_channel_1, &p_buffer, &size);
+    TEST_ASSERT_EQUAL_UINT32(5, T_cache.misses);
+    TEST_ASSERT_EQUAL_UINT32(2, T_cache.evictions);
+}
+
+/**
+ * @brief Test 6.5
+ *        Verificar que un preset mas grande que un slot devuelve error
+ *
+ * @param  -
+ * @return -
+ */
+void test_preset_mas_grande_que_slot(void) {
+    preset_t preset = T_preset_a;
+    int32_t * p_buffer = NULL;
+    uint16_t size = 0;
+    preset.freq = TEST_FREQ_SAMPLING / TEST_SLOT_SIZE - 1;
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR, presetCacheSelect(&T_cache, &preset, &T_channel_0,
+                                                          &T_channel_1, &p_buffer, &size));
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR, presetCacheSelect(&T_cache, (void *)0, &T_channel_0,
+                                                          &T_channel_1, &p_buffer, &size));
+    TEST_ASSERT_EQUAL_UINT32(0, T_cache.hits);
+    TEST_ASSERT_EQUAL_UINT32(0, T_cache.misses);
+    TEST_ASSERT_EQUAL_UINT32(0, T_cache.evictions);
+}
+
+/**
+ * @brief Test 6.6
+ *        Verificar que el flush vacia la cache y reinicia los contadores
+ *
+ * @param  -
+ * @return -
+ */
+void test_flush_de_cache(void) {
+    int32_t * p_buffer = NULL;
+    uint16_t size = 0;
+    presetCacheSelect(&T_cache, &T_preset_a, &T_channel_0, &T_channel_1, &p_buffer, &size);
+    presetCacheSelect(&T_cache, &T_preset_a, &T_channel_0, &T_channel_1, &p_buffer, &size);
+    TEST_ASSERT_EQUAL_INT(RETURN_OK, presetCacheFlush(&T_cache));
+    TEST_ASSERT_EQUAL_UINT32(0, T_cache.hits);
+    presetCacheSelect(&T_cache, &T_preset_a, &T_channel_0, &T_channel_1, &p_buffer, &size);
+    TEST_ASSERT_EQUAL_UINT32(0, T_cache.hits);
+    TEST_ASSERT_EQUAL_UINT32(1, T_cache.misses);
+}
+
+/**
+ * @brief Test 6.7
+ *        Verificar que un preset con forma de onda invalida devuelve error y no se guarda
+ *
+ * @param  -
+ * @return -
+ */
+void test_preset_con_forma_de_onda_invalida(void) {
+    preset_t preset = T_preset_a;
+    int32_t * p_buffer = NULL;
+    uint16_t size = 0;
+    preset.wave_ch1 = TRIANGLE_BL + 1;
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR, presetCacheSelect(&T_cache, &preset, &T_channel_0,
+                                                          &T_channel_1, &p_buffer, &size));
+    preset = T_preset_a;
+    preset.wave_ch0 = TRIANGLE_BL + 1;
+    TEST_ASSERT_EQUAL_INT(RETURN_ERROR, presetCacheSelect(&T_cache, &preset, &T_channel_0,
+                                                          &T_channel_1, &p_buffer, &size));
+    TEST_ASSERT_EQUAL_UINT32(0, T_cache.misses);
+    TEST_ASSERT_EQUAL_UINT32(0, T_cache.hits);
+}
@@ -0,0 +1,384 @@
+/************************************************************************************************
+Copyright (c) 2024, Flavio Miravete <flavio.miravete@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** @file
+ ** @brief Analizador de calidad espectral y velocidad del generador API_i2s (host)
+ *         Para cada modo de generacion, forma de onda y frecuencia arma la señal I2S,
+ *         separa el canal 0, calcula la FFT y reporta en una sola tabla:
+ *
+ *         f_meas    -> frecuencia medida (pico con interpolacion parabolica)
+ *         err       -> error de frecuencia respecto de la pedida [%]
+ *         THD+N     -> (potencia total - fundamental) / fundamental [dB]
+ *         SFDR      -> fundamental / mayor espuria (armonicos incluidos) [dB]
+ *         SNR       -> fundamental / (total - fundamental - armonicos) [dB]
+ *         Mframes/s -> velocidad de generacion de datos I2S en el host (mediana de
+ *                      BENCH_REPEATS mediciones)
+ *         spread    -> dispersion de las mediciones (max - min) / mediana [%]
+ *
+ *         En ondas no sinusoidales THD+N y SFDR quedan dominados por los armonicos
+ *         propios de la onda; el aliasing y el ruido de cuantizacion se ven en el SNR.
+ *         Con periodo entero (modo period) el aliasing cae sobre los armonicos de la
+ *         señal: se ve como error de forma (THD+N) y no como ruido.
+ *
+ *         Modos:
+ *         period  -> setBufferI2S (un periodo entero que se repite). La velocidad mide
+ *                    solo el armado del buffer I2S: las ondas de los canales ya estan
+ *                    calculadas y no se regeneran
+ *         nearest -> fillBufferI2S con INTERP_NONE
+ *         linear  -> fillBufferI2S con INTERP_LINEAR
+ *         cubic   -> fillBufferI2S con INTERP_CUBIC
+ *
+ *         Compilacion y uso (desde la raiz del repositorio):
+ *         mkdir -p build
+ *         gcc -O2 -Iinc tools/i2s_quality.c src/API_i2s.c -lm -o build/i2s_quality
+ *         ./build/i2s_quality [csv]
+ *
+ **/
+
+/* === Headers files inclusions =============================================================== */
+
+#include "API_i2s.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define FFT_SIZE_LOG2 16
+#define FFT_SIZE      (1u << FFT_SIZE_LOG2)
+#define MAIN_LOBE     6   // bins a cada lado del pico (ventana Blackman-Harris)
+#define BENCH_TIME    0.03 // segundos de cada medicion
+#define BENCH_REPEATS 9    // mediciones por configuracion (se reporta la mediana)
+#define BENCH_FRAMES  (1u << 16)
+
+/* === Private data type declarations ========================================================== */
+
+typedef struct gen_mode gen_mode;
+
+struct gen_mode {
+    const char * name;
+    interp_t interp;
+    void (*render)(const gen_mode * mode, int16_t * out, uint32_t n_samples);
+    uint32_t (*run)(const gen_mode * mode);
+};
+
+typedef struct {
+    double freq;
+    double thd_n;
+    double sfdr;
+    double snr;
+} quality;
+
+/* === Private variable declarations =========================================================== */
+
+static channel ch_0, ch_1;
+static int32_t buffer_I2S[BUFFER_SIZE_MAX];
+static int16_t signal_ch0[FFT_SIZE];
+static double fft_re[FFT_SIZE];
+static double fft_im[FFT_SIZE];
+static double power[FFT_SIZE / 2];
+
+/* === Private function declarations =========================================================== */
+
+static int16_t unpackChannel0(int32_t data);
+static void configChannels(const gen_mode * mode, wave_t wave_type, uint16_t freq);
+static void renderPeriod(const gen_mode * mode, int16_t * out, uint32_t n_samples);
+static uint32_t runPeriod(const gen_mode * mode);
+static void renderFill(const gen_mode * mode, int16_t * out, uint32_t n_samples);
+static uint32_t runFill(const gen_mode * mode);
+static void fft(double * re, double * im, uint32_t n);
+static double bandPower(double center, uint32_t * peak_lo, uint32_t * peak_hi);
+static void analyze(const int16_t * samples, quality * q);
+static double benchmark(const gen_mode * mode, wave_t wave_type, uint16_t freq,
+                        double * spread);
+static double now(void);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static const gen_mode modes[] = {
+    {"period", INTERP_NONE, renderPeriod, runPeriod},
+    {"nearest", INTERP_NONE, renderFill, runFill},
+    {"linear", INTERP_LINEAR, renderFill, runFill},
+    {"cubic", INTERP_CUBIC, renderFill, runFill},
+};
+
+static const struct {
+    wave_t wave_type;
+    const char * name;
+} waves[] = {
+    {SINUSOIDAL, "SINUSOIDAL"}, {SAWTOOTH, "SAWTOOTH"},       {SAWTOOTH_BL, "SAWTOOTH_BL"},
+    {SQUARE_BL, "SQUARE_BL"},   {TRIANGLE_BL, "TRIANGLE_BL"},
+};
+
+static const uint16_t freqs[] = {100, 1000, 7000, 15000};
+
+/* === Private function implementation ========================================================= */
+
+/*
+**********************************************************************************************************
+Funcion : int16_t unpackChannel0(int32_t data)
+Funcion que recupera el dato del canal 0 de un dato I2S igual que el hardware: los 16
+bits altos, sin mirar el canal 1.
+**********************************************************************************************************
+*/
+static int16_t unpackChannel0(int32_t data) {
+    return (int16_t)((uint32_t)data >> 16);
+}
+
+static void configChannels(const gen_mode * mode, wave_t wave_type, uint16_t freq) {
+    channelsInit(&ch_0, &ch_1);
+    ch_0.wave_type = wave_type;
+    ch_1.wave_type = wave_type;
+    setInterpChannel(&ch_0, mode->interp);
+    setInterpChannel(&ch_1, mode->interp);
+    setFreqChannels(&ch_0, &ch_1, freq);
+}
+
+/*
+**********************************************************************************************************
+Funcion : void renderPeriod(const gen_mode * mode, int16_t * out, uint32_t n_samples)
+Modo "period": un periodo armado con setBufferI2S que se repite (como lo hace el DMA
+circular del I2S). Los canales ya vienen configurados por configChannels.
+**********************************************************************************************************
+*/
+static void renderPeriod(const gen_mode * mode, int16_t * out, uint32_t n_samples) {
+    setBufferI2S(&ch_0, &ch_1, buffer_I2S);
+    for (uint32_t i = 0; i < n_samples; i++)
+        out[i] = unpackChannel0(buffer_I2S[i % ch_0.size_buffer]);
+    (void)mode;
+}
+
+static uint32_t runPeriod(const gen_mode * mode) {
+    setBufferI2S(&ch_0, &ch_1, buffer_I2S);
+    (void)mode;
+    return ch_0.size_buffer;
+}
+
+/*
+**********************************************************************************************************
+Funcion : void renderFill(const gen_mode * mode, int16_t * out, uint32_t n_samples)
+Modos "nearest", "linear" y "cubic": bloques de BUFFER_SIZE_MAX datos armados con
+fillBufferI2S (frecuencia exacta, fase continua entre bloques).
+**********************************************************************************************************
+*/
+static void renderFill(const gen_mode * mode, int16_t * out, uint32_t n_samples) {
+    for (uint32_t i = 0; i < n_samples; i += BUFFER_SIZE_MAX) {
+        uint32_t n_frames = n_samples - i < BUFFER_SIZE_MAX ? n_samples - i : BUFFER_SIZE_MAX;
+        fillBufferI2S(&ch_0, &ch_1, buffer_I2S, n_frames);
+        for (uint32_t j = 0; j < n_frames; j++)
+            out[i + j] = unpackChannel0(buffer_I2S[j]);
+    }
+    (void)mode;
+}
+
+static uint32_t runFill(const gen_mode * mode) {
+    fillBufferI2S(&ch_0, &ch_1, buffer_I2S, BUFFER_SIZE_MAX);
+    (void)mode;
+    return BUFFER_SIZE_MAX;
+}
+
+/*
+**********************************************************************************************************
+Funcion : void fft(double * re, double * im, uint32_t n)
+FFT compleja radix-2 iterativa (in place), n potencia de 2.
+**********************************************************************************************************
+*/
+static void fft(double * re, double * im, uint32_t n) {
+    for (uint32_t i = 1, j = 0; i < n; i++) {
+        uint32_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            double t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+    for (uint32_t len = 2; len <= n; len <<= 1) {
+        double ang = -2 * M_PI / len;
+        for (uint32_t i = 0; i < n; i += len) {
+            for (uint32_t k = 0; k < len / 2; k++) {
+                double wr = cos(ang * k);
+                double wi = sin(ang * k);
+                uint32_t a = i + k;
+                uint32_t b = a + len / 2;
+                double xr = re[b] * wr - im[b] * wi;
+                double xi = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - xr;
+                im[b] = im[a] - xi;
+                re[a] += xr;
+                im[a] += xi;
+            }
+        }
+    }
+}
+
+/*
+**********************************************************************************************************
+Funcion : double bandPower(double center, uint32_t * peak_lo, uint32_t * peak_hi)
+Funcion que suma la potencia de los bins del lobulo principal alrededor de center
+(en bins) y devuelve el rango usado para excluirlo de la busqueda de espurias.
+**********************************************************************************************************
+*/
+static double bandPower(double center, uint32_t * peak_lo, uint32_t * peak_hi) {
+    int32_t lo = (int32_t)lround(center) - MAIN_LOBE;
+    int32_t hi = (int32_t)lround(center) + MAIN_LOBE;
+    if (lo < 0)
+        lo = 0;
+    if (hi > (int32_t)(FFT_SIZE / 2 - 1))
+        hi = FFT_SIZE / 2 - 1;
+    double sum = 0;
+    for (int32_t i = lo; i <= hi; i++)
+        sum += power[i];
+    *peak_lo = lo;
+    *peak_hi = hi;
+    return sum;
+}
+
+/*
+**********************************************************************************************************
+Funcion : void analyze(const int16_t * samples, quality * q)
+Funcion que aplica ventana Blackman-Harris de 4 terminos, calcula el espectro de
+potencia y obtiene frecuencia, THD+N, SFDR y SNR de la fundamental.
+**********************************************************************************************************
+*/
+static void analyze(const int16_t * samples, quality * q) {
+    for (uint32_t i = 0; i < FFT_SIZE; i++) {
+        double x = 2 * M_PI * i / FFT_SIZE;
+        double w = 0.35875 - 0.48829 * cos(x) + 0.14128 * cos(2 * x) - 0.01168 * cos(3 * x);
+        fft_re[i] = samples[i] * w;
+        fft_im[i] = 0;
+    }
+    fft(fft_re, fft_im, FFT_SIZE);
+    double total = 0;
+    uint32_t peak = MAIN_LOBE + 1;
+    for (uint32_t i = 0; i < FFT_SIZE / 2; i++) {
+        power[i] = fft_re[i] * fft_re[i] + fft_im[i] * fft_im[i];
+        if (i > MAIN_LOBE) {
+            total += power[i];
+            if (power[i] > power[peak])
+                peak = i;
+        }
+    }
+
+    // Interpolacion parabolica sobre el logaritmo de la magnitud
+    double a = log(power[peak - 1] + 1e-30);
+    double b = log(power[peak] + 1e-30);
+    double c = log(power[peak + 1] + 1e-30);
+    double center = peak + 0.5 * (a - c) / (a - 2 * b + c);
+    q->freq = center * FREQ_SAMPLING / FFT_SIZE;
+
+    uint32_t fund_lo, fund_hi, lo, hi;
+    double fund = bandPower(center, &fund_lo, &fund_hi);
+    double harm = 0;
+    for (uint32_t k = 2; k * center < FFT_SIZE / 2; k++)
+        harm += bandPower(k * center, &lo, &hi);
+    double noise = total - fund - harm;
+
+    double spur = 1e-30;
+    for (uint32_t i = MAIN_LOBE + 1; i < FFT_SIZE / 2; i++) {
+        if ((i < fund_lo || i > fund_hi) && power[i] > spur)
+            spur = power[i];
+    }
+    q->thd_n = 10 * log10((total - fund) / fund + 1e-30);
+    q->sfdr = 10 * log10(power[peak] / spur);
+    q->snr = 10 * log10(fund / (noise > 1e-30 ? noise : 1e-30));
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+**********************************************************************************************************
+Funcion : double benchmark(const gen_mode * mode, wave_t wave_type, uint16_t freq,
+                           double * spread)
+Funcion que mide BENCH_REPEATS veces los datos I2S generados por segundo (cada medicion
+dura BENCH_TIME segundos) y devuelve la mediana. En spread devuelve la dispersion
+(max - min) / mediana, para saber cuanto confiar en la diferencia entre modos.
+**********************************************************************************************************
+*/
+static double benchmark(const gen_mode * mode, wave_t wave_type, uint16_t freq,
+                        double * spread) {
+    double rate[BENCH_REPEATS];
+    configChannels(mode, wave_type, freq);
+    for (uint8_t r = 0; r < BENCH_REPEATS; r++) {
+        uint64_t frames = 0;
+        double start = now();
+        double elapsed;
+        do {
+            uint32_t n = 0;
+            while (n < BENCH_FRAMES)
+                n += mode->run(mode);
+            frames += n;
+            elapsed = now() - start;
+        } while (elapsed < BENCH_TIME);
+        // Insercion ordenada
+        double value = frames / elapsed;
+        uint8_t i = r;
+        for (; i > 0 && rate[i - 1] > value; i--)
+            rate[i] = rate[i - 1];
+        rate[i] = value;
+    }
+    double median = rate[BENCH_REPEATS / 2];
+    *spread = (rate[BENCH_REPEATS - 1] - rate[0]) / median;
+    return median;
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(int argc, char * argv[]) {
+    bool csv = (argc > 1 && strcmp(argv[1], "csv") == 0);
+    if (csv)
+        printf("mode,wave,freq,f_meas,err_pct,thd_n_db,sfdr_db,snr_db,mframes_s,spread_pct\n");
+    else
+        printf("%-8s %-12s %6s %10s %8s %8s %8s %8s %10s %9s\n", "mode", "wave", "freq",
+               "f_meas", "err[%]", "THD+N", "SFDR", "SNR", "Mframes/s", "spread[%]");
+    for (uint8_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        for (uint8_t w = 0; w < sizeof(waves) / sizeof(waves[0]); w++) {
+            for (uint8_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); f++) {
+                quality q;
+                configChannels(&modes[m], waves[w].wave_type, freqs[f]);
+                modes[m].render(&modes[m], signal_ch0, FFT_SIZE);
+                analyze(signal_ch0, &q);
+                double err = 100.0 * (q.freq - freqs[f]) / freqs[f];
+                double spread;
+                double mfps = benchmark(&modes[m], waves[w].wave_type, freqs[f], &spread);
+                printf(csv ? "%s,%s,%u,%.3f,%.4f,%.2f,%.2f,%.2f,%.3f,%.1f\n"
+                           : "%-8s %-12s %6u %10.3f %8.4f %8.2f %8.2f %8.2f %10.3f %9.1f\n",
+                       modes[m].name, waves[w].name, freqs[f], q.freq, err, q.thd_n, q.sfdr,
+                       q.snr, mfps * 1e-6, 100 * spread);
+            }
+        }
+    }
+    return 0;
+}
+
+/* === End of documentation ==================================================================== */